@@ -0,0 +1,110 @@
+// 番茄钟文本格式化实现
+// 每秒调用的路径上不使用 printf、区域设置或堆分配
+#include "pomodoro_format.h"
+
+#include <string.h>
+
+// 带长度的字符串，长度在编译期算出
+typedef struct {
+    const wchar_t* text;
+    size_t length;
+} FormatString;
+
+#define FORMAT_ENTRY_ZH(id, zh, en) { zh, sizeof(zh) / sizeof(wchar_t) - 1 },
+#define FORMAT_ENTRY_EN(id, zh, en) { en, sizeof(en) / sizeof(wchar_t) - 1 },
+
+static const FormatString g_stringTables[FORMAT_LANG_COUNT][STR_COUNT] = {
+    { POMODORO_STRING_TABLE(FORMAT_ENTRY_ZH) },
+    { POMODORO_STRING_TABLE(FORMAT_ENTRY_EN) }
+};
+
+#undef FORMAT_ENTRY_ZH
+#undef FORMAT_ENTRY_EN
+
+// 两位数字表："00" 到 "99"
+static const char g_digitPairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+#define FORMAT_MAX_MINUTES 999  // 分钟样式最多三位分钟
+#define FORMAT_MAX_HOURS 99     // 小时样式最多两位小时
+
+// 当前语言的字符串表
+static const FormatString* g_currentTable = g_stringTables[FORMAT_LANG_ZH_CN];
+
+void FormatSelectLanguage(FormatLanguage language) {
+    if ((int)language < 0 || (int)language >= FORMAT_LANG_COUNT) {
+        language = FORMAT_LANG_ZH_CN;
+    }
+    g_currentTable = g_stringTables[language];
+}
+
+FormatLanguage FormatLanguageFromName(const wchar_t* name) {
+    if (name && (name[0] == L'e' || name[0] == L'E') && (name[1] == L'n' || name[1] == L'N') &&
+        (name[2] == L'\0' || name[2] == L'-' || name[2] == L'_')) {
+        return FORMAT_LANG_EN;
+    }
+    return FORMAT_LANG_ZH_CN;
+}
+
+const wchar_t* FormatGetString(StringId id) {
+    return g_currentTable[id].text;
+}
+
+size_t FormatCopyString(StringId id, wchar_t* buffer, size_t capacity) {
+    if (capacity == 0) return 0;
+
+    const FormatString* s = &g_currentTable[id];
+    size_t length = s->length < capacity - 1 ? s->length : capacity - 1;
+    memcpy(buffer, s->text, length * sizeof(wchar_t));
+    buffer[length] = L'\0';
+    return length;
+}
+
+// 写入两位数字
+static wchar_t* PutPair(wchar_t* p, int value) {
+    p[0] = (wchar_t)g_digitPairs[value * 2];
+    p[1] = (wchar_t)g_digitPairs[value * 2 + 1];
+    return p + 2;
+}
+
+size_t FormatClock(int seconds, FormatClockStyle style, wchar_t* buffer) {
+    if (seconds < 0) seconds = 0;
+
+    int minutes = seconds / 60;
+    int secs = seconds % 60;
+    wchar_t* p = buffer;
+
+    if (style == FORMAT_CLOCK_HOURS && minutes >= 60) {
+        int hours = minutes / 60;
+        minutes %= 60;
+        if (hours > FORMAT_MAX_HOURS) {
+            hours = FORMAT_MAX_HOURS;
+            minutes = 59;
+            secs = 59;
+        }
+        if (hours >= 10) {
+            p = PutPair(p, hours);
+        } else {
+            *p++ = (wchar_t)(L'0' + hours);
+        }
+        *p++ = L':';
+    } else {
+        if (minutes > FORMAT_MAX_MINUTES) {
+            minutes = FORMAT_MAX_MINUTES;
+            secs = 59;
+        }
+        if (minutes >= 100) {
+            *p++ = (wchar_t)(L'0' + minutes / 100);
+            minutes %= 100;
+        }
+    }
+
+    p = PutPair(p, minutes);
+    *p++ = L':';
+    p = PutPair(p, secs);
+    *p = L'\0';
+    return (size_t)(p - buffer);
+}
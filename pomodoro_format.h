@@ -0,0 +1,74 @@
+// 番茄钟文本格式化：编译期字符串表 + 查表时间格式化
+#ifndef POMODORO_FORMAT_H
+#define POMODORO_FORMAT_H
+
+#include <stddef.h>
+#include <wchar.h>
+
+// 界面语言
+typedef enum {
+    FORMAT_LANG_ZH_CN,  // 简体中文（默认）
+    FORMAT_LANG_EN,     // English
+    FORMAT_LANG_COUNT
+} FormatLanguage;
+
+// 字符串表：X(编号, 简体中文, English)
+// 每种语言都必须给出每个字符串，缺项会在编译期报错
+#define POMODORO_STRING_TABLE(X) \
+    X(STR_APP_TITLE,          L"番茄钟",             L"Pomodoro") \
+    X(STR_STATUS_WORK,        L"工作中",             L"Working") \
+    X(STR_STATUS_WORK_PAUSED, L"工作中 - 点击开始",  L"Work - click to start") \
+    X(STR_STATUS_BREAK,       L"休息中",             L"On break") \
+    X(STR_STATUS_BREAK_PAUSED, L"休息中 - 点击开始", L"Break - click to start") \
+    X(STR_HINT_START,         L"点击窗口开始计时",   L"Click the window to start") \
+    X(STR_TRAY_WORK,          L"番茄钟 - 工作中",    L"Pomodoro - Working") \
+    X(STR_TRAY_BREAK,         L"番茄钟 - 休息中",    L"Pomodoro - On break") \
+    X(STR_MENU_START,         L"开始",               L"Start") \
+    X(STR_MENU_PAUSE,         L"暂停",               L"Pause") \
+    X(STR_MENU_RESET,         L"重置",               L"Reset") \
+    X(STR_MENU_EXIT,          L"退出",               L"Exit") \
+    X(STR_SETTINGS,           L"设置",               L"Settings") \
+    X(STR_WORK_MINUTES,       L"工作时长（分钟）:",  L"Work (minutes):") \
+    X(STR_BREAK_MINUTES,      L"休息时长（分钟）:",  L"Break (minutes):") \
+    X(STR_SAVE,               L"保存",               L"Save") \
+    X(STR_CANCEL,             L"取消",               L"Cancel") \
+    X(STR_NOTIFY_WORK,        L"休息结束，开始工作！", L"Break is over, back to work!") \
+    X(STR_NOTIFY_BREAK,       L"开始休息！",         L"Time for a break!") \
+    X(STR_INPUT_ERROR_TITLE,  L"输入错误",           L"Invalid input") \
+    X(STR_INPUT_ERROR, \
+      L"请输入有效的时间范围（工作: 1-120分钟，休息: 1-60分钟）", \
+      L"Please enter a valid range (work: 1-120 min, break: 1-60 min)")
+
+// 字符串编号
+typedef enum {
+#define FORMAT_STRING_ID(id, zh, en) id,
+    POMODORO_STRING_TABLE(FORMAT_STRING_ID)
+#undef FORMAT_STRING_ID
+    STR_COUNT
+} StringId;
+
+// 时间显示样式
+typedef enum {
+    FORMAT_CLOCK_MINUTES,  // "MM:SS"，超过一小时仍按分钟显示（如 "120:00"）
+    FORMAT_CLOCK_HOURS     // 不足一小时为 "MM:SS"，否则为 "H:MM:SS"
+} FormatClockStyle;
+
+#define FORMAT_CLOCK_MAX 16  // FormatClock 缓冲区所需的最小长度（字符）
+
+// 选择当前语言（启动时调用一次）
+void FormatSelectLanguage(FormatLanguage language);
+
+// 按名称解析语言（如 "zh-CN"、"en"），无法识别时返回默认语言
+FormatLanguage FormatLanguageFromName(const wchar_t* name);
+
+// 取当前语言的字符串
+const wchar_t* FormatGetString(StringId id);
+
+// 把字符串复制到定长缓冲区（超长截断），返回写入的字符数
+size_t FormatCopyString(StringId id, wchar_t* buffer, size_t capacity);
+
+// 格式化时间，buffer 至少 FORMAT_CLOCK_MAX 个字符；返回写入的字符数
+// 负数按0处理，超出显示范围时取最大值
+size_t FormatClock(int seconds, FormatClockStyle style, wchar_t* buffer);
+
+#endif // POMODORO_FORMAT_H
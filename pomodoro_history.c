@@ -0,0 +1,673 @@
+// 番茄钟历史归档实现
+//
+// 文件布局（均位于程序目录）：
+//   pomodoro_history.log     新完成的记录，定长追加（UI线程写入）
+//   pomodoro_history.pending 压缩器从日志改名得到，正在合并
+//   pomodoro_history.stage   不足一块的记录，定长存放（仅压缩器写入）
+//   pomodoro_history.dat     封存块，差分 + 变长整数编码
+//   pomodoro_history.idx     每个封存块一项的定长索引（含块首时间与时间范围）
+//
+// 每条记录追加时分配一个递增的序号，合并时序号不大于已保留记录的会被丢弃，
+// 保证崩溃后重复合并的记录只保留一份。去重不依赖系统时钟，
+// 时钟回拨后完成的记录照常保存。
+//
+// 定长记录带有校验值，读取时跳过校验失败的字节并重新对齐，
+// 追加中断留下的半条记录不会让之后的记录错位。
+//
+// 封存时块数据落盘后才写索引项，索引落盘后才替换暂存区，
+// 掉电后索引不会指向未写完的块，已封存的记录也不会只存在于缓存中。
+// 个别块仍损坏时（如介质错误），查询跳过该块并报告，其余记录照常返回。
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "pomodoro_history.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define HistoryFopen _wfopen
+#define HistoryRename _wrename
+#define HistoryRemove _wremove
+#define HistoryTruncate(file, size) _chsize(_fileno(file), (long)(size))
+#define HistorySync(file) _commit(_fileno(file))
+#define HistoryLockInit(lock) InitializeCriticalSection(lock)
+#define HistoryLockDestroy(lock) DeleteCriticalSection(lock)
+#define HistoryLockAcquire(lock) EnterCriticalSection(lock)
+#define HistoryLockRelease(lock) LeaveCriticalSection(lock)
+#else
+#include <unistd.h>
+#define HistoryFopen fopen
+#define HistoryRename rename
+#define HistoryRemove remove
+#define HistoryTruncate(file, size) ftruncate(fileno(file), (off_t)(size))
+#define HistorySync(file) fsync(fileno(file))
+#define HistoryLockInit(lock) pthread_mutex_init(lock, NULL)
+#define HistoryLockDestroy(lock) pthread_mutex_destroy(lock)
+#define HistoryLockAcquire(lock) pthread_mutex_lock(lock)
+#define HistoryLockRelease(lock) pthread_mutex_unlock(lock)
+#endif
+
+#define HISTORY_RAW_PAYLOAD_BYTES 25  // 定长记录中校验值之前的字节数
+
+// 未封存的记录及其追加序号
+typedef struct {
+    SessionRecord record;
+    uint64_t sequence;
+} RawRecord;
+
+// 动态记录数组
+typedef struct {
+    RawRecord* items;
+    size_t count;
+    size_t capacity;
+} RecordList;
+
+// ---- 字节序与变长整数 ----
+
+static void PutU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t GetU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void PutI64(uint8_t* p, int64_t v) {
+    PutU32(p, (uint32_t)((uint64_t)v & 0xFFFFFFFFu));
+    PutU32(p + 4, (uint32_t)((uint64_t)v >> 32));
+}
+
+static int64_t GetI64(const uint8_t* p) {
+    return (int64_t)((uint64_t)GetU32(p) | ((uint64_t)GetU32(p + 4) << 32));
+}
+
+static uint8_t* PutVarint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// 读取变长整数，数据不足或过长时返回NULL
+static const uint8_t* GetVarint(const uint8_t* p, const uint8_t* end, uint64_t* value) {
+    uint64_t result = 0;
+    int shift = 0;
+    while (p < end && shift < 64) {
+        uint8_t b = *p++;
+        result |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *value = result;
+            return p;
+        }
+        shift += 7;
+    }
+    return NULL;
+}
+
+static uint64_t ZigZag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t UnZigZag(uint64_t v) {
+    return (int64_t)((v >> 1) ^ (~(v & 1) + 1));
+}
+
+static uint32_t Fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// ---- 块编解码 ----
+//
+// 每条记录依次编码为：
+//   zigzag(开始时间 - 上一条结束时间)    连续的阶段几乎总是0
+//   标志字节: bit0 = 工作, bit1 = 计划时长与同类上一条不同
+//   [计划时长]                           仅当bit1置位
+//   zigzag(实际时长 - 计划时长)
+
+size_t HistoryEncodeBlock(const SessionRecord* records, uint32_t count, uint8_t* out) {
+    uint8_t* p = out;
+    if (count == 0) return 0;
+
+    int64_t prevEnd = records[0].startTime;
+    uint32_t prevPlanned[2] = {0, 0};
+    for (uint32_t i = 0; i < count; i++) {
+        const SessionRecord* r = &records[i];
+        int phase = r->isWorking ? 1 : 0;
+        int plannedChanged = r->plannedSeconds != prevPlanned[phase];
+
+        p = PutVarint(p, ZigZag(r->startTime - prevEnd));
+        *p++ = (uint8_t)(phase | (plannedChanged << 1));
+        if (plannedChanged) {
+            p = PutVarint(p, r->plannedSeconds);
+            prevPlanned[phase] = r->plannedSeconds;
+        }
+        p = PutVarint(p, ZigZag((int64_t)r->elapsedSeconds - (int64_t)r->plannedSeconds));
+        prevEnd = r->startTime + r->elapsedSeconds;
+    }
+    return (size_t)(p - out);
+}
+
+int HistoryDecodeBlock(const uint8_t* data, size_t length, int64_t firstTime,
+                       uint32_t count, SessionRecord* out) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + length;
+    int64_t prevEnd = firstTime;
+    uint32_t prevPlanned[2] = {0, 0};
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t gap, planned, diff;
+        if (!(p = GetVarint(p, end, &gap)) || p >= end) return -1;
+        uint8_t flags = *p++;
+        if (flags > 3) return -1;
+
+        int phase = flags & 1;
+        if (flags & 2) {
+            if (!(p = GetVarint(p, end, &planned)) || planned > UINT32_MAX) return -1;
+            prevPlanned[phase] = (uint32_t)planned;
+        }
+        if (!(p = GetVarint(p, end, &diff))) return -1;
+
+        int64_t elapsed = (int64_t)prevPlanned[phase] + UnZigZag(diff);
+        if (elapsed < 0 || elapsed > (int64_t)UINT32_MAX) return -1;
+
+        out[i].startTime = prevEnd + UnZigZag(gap);
+        out[i].plannedSeconds = prevPlanned[phase];
+        out[i].elapsedSeconds = (uint32_t)elapsed;
+        out[i].isWorking = (uint8_t)phase;
+        prevEnd = out[i].startTime + elapsed;
+    }
+    return p == end ? 0 : -1;
+}
+
+// ---- 定长记录与索引 ----
+
+static void PutU64(uint8_t* p, uint64_t v) {
+    PutU32(p, (uint32_t)(v & 0xFFFFFFFFu));
+    PutU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t GetU64(const uint8_t* p) {
+    return (uint64_t)GetU32(p) | ((uint64_t)GetU32(p + 4) << 32);
+}
+
+static void EncodeRaw(const RawRecord* r, uint8_t* p) {
+    PutU64(p, r->sequence);
+    PutI64(p + 8, r->record.startTime);
+    PutU32(p + 16, r->record.plannedSeconds);
+    PutU32(p + 20, r->record.elapsedSeconds);
+    p[24] = r->record.isWorking ? 1 : 0;
+    PutU32(p + HISTORY_RAW_PAYLOAD_BYTES, Fnv1a(p, HISTORY_RAW_PAYLOAD_BYTES));
+}
+
+static int IsValidRaw(const uint8_t* p) {
+    return p[24] <= 1 && GetU32(p + HISTORY_RAW_PAYLOAD_BYTES) == Fnv1a(p, HISTORY_RAW_PAYLOAD_BYTES);
+}
+
+static void DecodeRaw(const uint8_t* p, RawRecord* r) {
+    r->sequence = GetU64(p);
+    r->record.startTime = GetI64(p + 8);
+    r->record.plannedSeconds = GetU32(p + 16);
+    r->record.elapsedSeconds = GetU32(p + 20);
+    r->record.isWorking = p[24] ? 1 : 0;
+}
+
+static void EncodeIndex(const HistoryBlockIndex* e, uint8_t* p) {
+    PutI64(p, e->firstTime);
+    PutI64(p + 8, e->minTime);
+    PutI64(p + 16, e->maxTime);
+    PutU64(p + 24, e->lastSequence);
+    PutU32(p + 32, e->offset);
+    PutU32(p + 36, e->length);
+    PutU32(p + 40, e->count);
+    PutU32(p + 44, e->checksum);
+}
+
+static void DecodeIndex(const uint8_t* p, HistoryBlockIndex* e) {
+    e->firstTime = GetI64(p);
+    e->minTime = GetI64(p + 8);
+    e->maxTime = GetI64(p + 16);
+    e->lastSequence = GetU64(p + 24);
+    e->offset = GetU32(p + 32);
+    e->length = GetU32(p + 36);
+    e->count = GetU32(p + 40);
+    e->checksum = GetU32(p + 44);
+}
+
+// 读取全部索引项，末尾不完整的项（写入中断）会被忽略
+static int LoadIndex(const HistoryArchive* archive, HistoryBlockIndex** entries, size_t* count) {
+    *entries = NULL;
+    *count = 0;
+
+    FILE* file = HistoryFopen(archive->indexPath, HISTORY_TEXT("rb"));
+    if (!file) return 0;
+
+    size_t capacity = 0;
+    uint8_t buffer[HISTORY_INDEX_ENTRY_BYTES];
+    while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer)) {
+        if (*count == capacity) {
+            size_t newCapacity = capacity ? capacity * 2 : 64;
+            HistoryBlockIndex* grown = realloc(*entries, newCapacity * sizeof(HistoryBlockIndex));
+            if (!grown) {
+                fclose(file);
+                free(*entries);
+                *entries = NULL;
+                *count = 0;
+                return -1;
+            }
+            *entries = grown;
+            capacity = newCapacity;
+        }
+        DecodeIndex(buffer, &(*entries)[(*count)++]);
+    }
+    fclose(file);
+    return 0;
+}
+
+static int PushRecord(RecordList* list, const RawRecord* record) {
+    if (list->count == list->capacity) {
+        size_t newCapacity = list->capacity ? list->capacity * 2 : HISTORY_BLOCK_RECORDS;
+        RawRecord* grown = realloc(list->items, newCapacity * sizeof(RawRecord));
+        if (!grown) return -1;
+        list->items = grown;
+        list->capacity = newCapacity;
+    }
+    list->items[list->count++] = *record;
+    return 0;
+}
+
+// 读取整个文件；文件不存在时 *data 为NULL、*size 为0
+static int ReadWholeFile(const HistoryChar* path, uint8_t** data, size_t* size) {
+    *data = NULL;
+    *size = 0;
+
+    FILE* file = HistoryFopen(path, HISTORY_TEXT("rb"));
+    if (!file) return 0;
+
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    uint8_t* buffer = malloc(length > 0 ? (size_t)length : 1);
+    if (!buffer || fread(buffer, 1, (size_t)length, file) != (size_t)length) {
+        free(buffer);
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+    *data = buffer;
+    *size = (size_t)length;
+    return 0;
+}
+
+// 找到从 *pos 开始的下一条有效记录，校验失败时逐字节向后重新对齐
+static const uint8_t* NextValidRaw(const uint8_t* data, size_t size, size_t* pos) {
+    while (*pos + HISTORY_RAW_RECORD_BYTES <= size) {
+        const uint8_t* p = data + *pos;
+        if (IsValidRaw(p)) {
+            *pos += HISTORY_RAW_RECORD_BYTES;
+            return p;
+        }
+        (*pos)++;
+    }
+    return NULL;
+}
+
+// 读取定长记录文件，只保留序号大于 *lastSequence 的有效记录
+static int LoadRawFile(const HistoryChar* path, uint64_t* lastSequence, RecordList* list) {
+    uint8_t* data;
+    size_t size;
+    if (ReadWholeFile(path, &data, &size) != 0) return -1;
+
+    int result = 0;
+    size_t pos = 0;
+    const uint8_t* p;
+    while ((p = NextValidRaw(data, size, &pos)) != NULL) {
+        RawRecord record;
+        DecodeRaw(p, &record);
+        if (record.sequence <= *lastSequence) continue;
+        if (PushRecord(list, &record) != 0) {
+            result = -1;
+            break;
+        }
+        *lastSequence = record.sequence;
+    }
+    free(data);
+    return result;
+}
+
+// 去掉日志中中断追加留下的残缺字节，使之后的追加重新对齐
+static int RepairLog(const HistoryArchive* archive) {
+    uint8_t* data;
+    size_t size;
+    if (ReadWholeFile(archive->logPath, &data, &size) != 0) return -1;
+
+    size_t pos = 0, kept = 0;
+    const uint8_t* p;
+    while ((p = NextValidRaw(data, size, &pos)) != NULL) {
+        memmove(data + kept, p, HISTORY_RAW_RECORD_BYTES);
+        kept += HISTORY_RAW_RECORD_BYTES;
+    }
+
+    int result = 0;
+    if (kept != size) {
+        FILE* file = HistoryFopen(archive->logPath, HISTORY_TEXT("r+b"));
+        if (!file || fwrite(data, 1, kept, file) != kept || fflush(file) != 0 ||
+            HistoryTruncate(file, kept) != 0) {
+            result = -1;
+        }
+        if (file && fclose(file) != 0) result = -1;
+    }
+    free(data);
+    return result;
+}
+
+static int FileExists(const HistoryChar* path) {
+    FILE* file = HistoryFopen(path, HISTORY_TEXT("rb"));
+    if (!file) return 0;
+    fclose(file);
+    return 1;
+}
+
+// 打开文件用于覆盖写入，不存在时创建
+// 把用户态缓冲和系统缓存都写到磁盘
+static int SyncFile(FILE* file) {
+    return (fflush(file) == 0 && HistorySync(file) == 0) ? 0 : -1;
+}
+
+static FILE* OpenForUpdate(const HistoryChar* path) {
+    FILE* file = HistoryFopen(path, HISTORY_TEXT("r+b"));
+    if (!file) file = HistoryFopen(path, HISTORY_TEXT("w+b"));
+    return file;
+}
+
+static void BuildPath(HistoryChar* out, const HistoryChar* directory, const HistoryChar* name) {
+    size_t n = 0;
+    while (*directory && n < HISTORY_PATH_MAX - 1) out[n++] = *directory++;
+    while (*name && n < HISTORY_PATH_MAX - 1) out[n++] = *name++;
+    out[n] = 0;
+}
+
+// ---- 公共接口 ----
+
+int HistoryInit(HistoryArchive* archive, const HistoryChar* directory) {
+    size_t length = 0;
+    while (directory[length]) length++;
+    // 预留最长文件名 "pomodoro_history.stage.tmp" 的空间
+    if (length + 32 >= HISTORY_PATH_MAX) return -1;
+
+    BuildPath(archive->dataPath, directory, HISTORY_TEXT("pomodoro_history.dat"));
+    BuildPath(archive->indexPath, directory, HISTORY_TEXT("pomodoro_history.idx"));
+    BuildPath(archive->logPath, directory, HISTORY_TEXT("pomodoro_history.log"));
+    BuildPath(archive->pendingPath, directory, HISTORY_TEXT("pomodoro_history.pending"));
+    BuildPath(archive->stagePath, directory, HISTORY_TEXT("pomodoro_history.stage"));
+    BuildPath(archive->stageTmpPath, directory, HISTORY_TEXT("pomodoro_history.stage.tmp"));
+
+    if (RepairLog(archive) != 0) return -1;
+
+    // 从索引和未封存的文件中找出最大的序号
+    HistoryBlockIndex* index;
+    size_t indexCount;
+    if (LoadIndex(archive, &index, &indexCount) != 0) return -1;
+    uint64_t lastSequence = indexCount ? index[indexCount - 1].lastSequence : 0;
+    free(index);
+
+    const HistoryChar* rawPaths[4] = {
+        archive->stagePath, archive->stageTmpPath, archive->pendingPath, archive->logPath
+    };
+    for (int i = 0; i < 4; i++) {
+        RecordList list = {0};
+        int result = LoadRawFile(rawPaths[i], &lastSequence, &list);
+        free(list.items);
+        if (result != 0) return -1;
+    }
+    archive->nextSequence = lastSequence + 1;
+    HistoryLockInit(&archive->logLock);
+    return 0;
+}
+
+void HistoryClose(HistoryArchive* archive) {
+    HistoryLockDestroy(&archive->logLock);
+}
+
+int HistoryAppend(HistoryArchive* archive, const SessionRecord* record) {
+    RawRecord raw;
+    raw.record = *record;
+    raw.sequence = archive->nextSequence++;
+
+    uint8_t buffer[HISTORY_RAW_RECORD_BYTES];
+    EncodeRaw(&raw, buffer);
+
+    // 持锁期间压缩器不会改名日志，写入的记录不会落进已被读取的 pending 文件
+    HistoryLockAcquire(&archive->logLock);
+    FILE* file = HistoryFopen(archive->logPath, HISTORY_TEXT("ab"));
+    if (!file) {
+        HistoryLockRelease(&archive->logLock);
+        return -1;
+    }
+    setvbuf(file, NULL, _IONBF, 0);  // 不缓冲，失败回退后关闭文件时不会再写出残留数据
+
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    int ok = fwrite(buffer, 1, sizeof(buffer), file) == sizeof(buffer) && fflush(file) == 0;
+    if (!ok && size >= 0) {
+        // 写入失败（如磁盘已满）时回退到追加前的长度，不留下半条记录
+        clearerr(file);
+        HistoryTruncate(file, size);
+    }
+    if (fclose(file) != 0) ok = 0;
+    HistoryLockRelease(&archive->logLock);
+    return ok ? 0 : -1;
+}
+
+// 恢复上次中断的暂存区替换
+static void RecoverStage(const HistoryArchive* archive) {
+    if (!FileExists(archive->stageTmpPath)) return;
+    if (FileExists(archive->stagePath)) {
+        // 旧暂存区仍在，临时文件可能不完整
+        HistoryRemove(archive->stageTmpPath);
+    } else {
+        HistoryRename(archive->stageTmpPath, archive->stagePath);
+    }
+}
+
+// 用剩余记录替换暂存区
+static int WriteStage(const HistoryArchive* archive, const RawRecord* records, size_t count) {
+    if (count > 0) {
+        FILE* file = HistoryFopen(archive->stageTmpPath, HISTORY_TEXT("wb"));
+        if (!file) return -1;
+
+        uint8_t buffer[HISTORY_RAW_RECORD_BYTES];
+        int ok = 1;
+        for (size_t i = 0; i < count && ok; i++) {
+            EncodeRaw(&records[i], buffer);
+            ok = fwrite(buffer, 1, sizeof(buffer), file) == sizeof(buffer);
+        }
+        // 改名前落盘，替换后的暂存区不会是空文件或半个文件
+        if (ok) ok = SyncFile(file) == 0;
+        if (fclose(file) != 0 || !ok) {
+            HistoryRemove(archive->stageTmpPath);
+            return -1;
+        }
+    }
+
+    HistoryRemove(archive->stagePath);
+    if (count > 0 && HistoryRename(archive->stageTmpPath, archive->stagePath) != 0) return -1;
+    return 0;
+}
+
+// 把 records 中的满块写入数据文件并追加索引
+static int SealBlocks(const HistoryArchive* archive, const HistoryBlockIndex* index,
+                      size_t indexCount, const RawRecord* records, size_t blockCount) {
+    uint8_t encoded[HISTORY_BLOCK_RECORDS * HISTORY_MAX_RECORD_BYTES];
+    SessionRecord block[HISTORY_BLOCK_RECORDS];
+
+    // 从最后一个有效块之后写入，覆盖中断时遗留的无索引数据
+    uint32_t offset = indexCount ? index[indexCount - 1].offset + index[indexCount - 1].length : 0;
+
+    FILE* data = OpenForUpdate(archive->dataPath);
+    if (!data) return -1;
+    FILE* indexFile = OpenForUpdate(archive->indexPath);
+    if (!indexFile) {
+        fclose(data);
+        return -1;
+    }
+
+    int result = 0;
+    if (fseek(data, (long)offset, SEEK_SET) != 0 ||
+        fseek(indexFile, (long)(indexCount * HISTORY_INDEX_ENTRY_BYTES), SEEK_SET) != 0) {
+        result = -1;
+    }
+
+    for (size_t b = 0; b < blockCount && result == 0; b++) {
+        const RawRecord* raw = records + b * HISTORY_BLOCK_RECORDS;
+        HistoryBlockIndex entry;
+        entry.firstTime = raw[0].record.startTime;
+        entry.minTime = entry.firstTime;
+        entry.maxTime = entry.firstTime;
+        for (uint32_t i = 0; i < HISTORY_BLOCK_RECORDS; i++) {
+            block[i] = raw[i].record;
+            if (block[i].startTime < entry.minTime) entry.minTime = block[i].startTime;
+            if (block[i].startTime > entry.maxTime) entry.maxTime = block[i].startTime;
+        }
+        entry.lastSequence = raw[HISTORY_BLOCK_RECORDS - 1].sequence;
+        entry.offset = offset;
+        entry.length = (uint32_t)HistoryEncodeBlock(block, HISTORY_BLOCK_RECORDS, encoded);
+        entry.count = HISTORY_BLOCK_RECORDS;
+        entry.checksum = Fnv1a(encoded, entry.length);
+
+        // 数据落盘后再写索引，索引项存在即代表块已完整写入
+        uint8_t indexBuffer[HISTORY_INDEX_ENTRY_BYTES];
+        EncodeIndex(&entry, indexBuffer);
+        if (fwrite(encoded, 1, entry.length, data) != entry.length || SyncFile(data) != 0 ||
+            fwrite(indexBuffer, 1, sizeof(indexBuffer), indexFile) != sizeof(indexBuffer) ||
+            fflush(indexFile) != 0) {
+            result = -1;
+        }
+        offset += entry.length;
+    }
+
+    // 索引落盘后调用方才会从暂存区删去已封存的记录
+    if (result == 0 && SyncFile(indexFile) != 0) result = -1;
+
+    if (fclose(indexFile) != 0) result = -1;
+    if (fclose(data) != 0) result = -1;
+    return result;
+}
+
+int HistoryCompact(HistoryArchive* archive) {
+    RecoverStage(archive);
+
+    // 取走当前日志；UI线程之后的追加会写入新的日志文件
+    // 若上次压缩中断，先处理遗留的 pending 文件
+    if (!FileExists(archive->pendingPath)) {
+        HistoryLockAcquire(&archive->logLock);
+        int renamed = HistoryRename(archive->logPath, archive->pendingPath) == 0;
+        HistoryLockRelease(&archive->logLock);
+        if (!renamed) return 0;
+    }
+
+    HistoryBlockIndex* index;
+    size_t indexCount;
+    if (LoadIndex(archive, &index, &indexCount) != 0) return -1;
+
+    uint64_t lastSequence = indexCount ? index[indexCount - 1].lastSequence : 0;
+    RecordList list = {0};
+    int result = LoadRawFile(archive->stagePath, &lastSequence, &list);
+    if (result == 0) result = LoadRawFile(archive->pendingPath, &lastSequence, &list);
+
+    size_t blockCount = list.count / HISTORY_BLOCK_RECORDS;
+    if (result == 0 && blockCount > 0) {
+        result = SealBlocks(archive, index, indexCount, list.items, blockCount);
+    }
+    if (result == 0) {
+        size_t sealed = blockCount * HISTORY_BLOCK_RECORDS;
+        result = WriteStage(archive, list.items + sealed, list.count - sealed);
+    }
+    if (result == 0) {
+        HistoryRemove(archive->pendingPath);
+    }
+
+    free(list.items);
+    free(index);
+    return result;
+}
+
+static long VisitRecord(const SessionRecord* record, int64_t from, int64_t to,
+                        HistoryVisitFn visit, void* context) {
+    if (record->startTime < from || record->startTime > to) return 0;
+    if (visit) visit(record, context);
+    return 1;
+}
+
+long HistoryQueryRange(const HistoryArchive* archive, int64_t from, int64_t to,
+                       HistoryVisitFn visit, void* context, uint32_t* skippedBlocks) {
+    uint8_t encoded[HISTORY_BLOCK_RECORDS * HISTORY_MAX_RECORD_BYTES];
+    SessionRecord decoded[HISTORY_BLOCK_RECORDS];
+
+    if (skippedBlocks) *skippedBlocks = 0;
+    if (from > to) return 0;
+
+    HistoryBlockIndex* index;
+    size_t indexCount;
+    if (LoadIndex(archive, &index, &indexCount) != 0) return -1;
+
+    // 只读取时间范围与查询重叠的块（时钟回拨时块之间的时间不一定有序）
+    long total = 0;
+    FILE* data = NULL;
+    for (size_t b = 0; b < indexCount && total >= 0; b++) {
+        const HistoryBlockIndex* e = &index[b];
+        if (e->maxTime < from || e->minTime > to) continue;
+
+        if (!data && !(data = HistoryFopen(archive->dataPath, HISTORY_TEXT("rb")))) {
+            total = -1;
+            break;
+        }
+        if (e->count > HISTORY_BLOCK_RECORDS || e->length > sizeof(encoded) ||
+            fseek(data, (long)e->offset, SEEK_SET) != 0 ||
+            fread(encoded, 1, e->length, data) != e->length ||
+            Fnv1a(encoded, e->length) != e->checksum ||
+            HistoryDecodeBlock(encoded, e->length, e->firstTime, e->count, decoded) != 0) {
+            // 损坏的块不影响其他块，也不会以错误内容返回
+            if (skippedBlocks) (*skippedBlocks)++;
+            continue;
+        }
+        for (uint32_t i = 0; i < e->count; i++) {
+            total += VisitRecord(&decoded[i], from, to, visit, context);
+        }
+    }
+    if (data) fclose(data);
+
+    // 未封存的记录：暂存区、正在压缩的日志、新日志，按序号去掉已访问的记录
+    uint64_t lastSequence = indexCount ? index[indexCount - 1].lastSequence : 0;
+    const HistoryChar* rawPaths[3] = {archive->stagePath, archive->pendingPath, archive->logPath};
+    for (int i = 0; i < 3 && total >= 0; i++) {
+        RecordList list = {0};
+        if (LoadRawFile(rawPaths[i], &lastSequence, &list) != 0) {
+            total = -1;
+        } else {
+            for (size_t j = 0; j < list.count; j++) {
+                total += VisitRecord(&list.items[j].record, from, to, visit, context);
+            }
+        }
+        free(list.items);
+    }
+
+    free(index);
+    return total;
+}
@@ -0,0 +1,92 @@
+// 番茄钟历史归档：按块进行差分 + 变长整数编码
+#ifndef POMODORO_HISTORY_H
+#define POMODORO_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 路径字符类型（Windows下使用宽字符以支持中文目录）与日志锁
+#ifdef _WIN32
+#include <windows.h>
+#include <wchar.h>
+typedef wchar_t HistoryChar;
+typedef CRITICAL_SECTION HistoryLock;
+#define HISTORY_TEXT(s) L##s
+#else
+#include <pthread.h>
+typedef char HistoryChar;
+typedef pthread_mutex_t HistoryLock;
+#define HISTORY_TEXT(s) s
+#endif
+
+#define HISTORY_PATH_MAX 520          // 路径最大长度（字符）
+#define HISTORY_BLOCK_RECORDS 256     // 每个封存块的记录数
+#define HISTORY_MAX_RECORD_BYTES 26   // 单条记录编码后的最大字节数
+#define HISTORY_RAW_RECORD_BYTES 29   // 日志中定长记录的字节数（含序号和校验值）
+#define HISTORY_INDEX_ENTRY_BYTES 48  // 索引项的字节数
+
+// 已完成的阶段记录
+typedef struct {
+    int64_t startTime;        // 阶段开始时间(Unix秒)
+    uint32_t plannedSeconds;  // 计划时长(秒)
+    uint32_t elapsedSeconds;  // 实际经过时长(秒，含暂停)
+    uint8_t isWorking;        // 1 = 工作，0 = 休息
+} SessionRecord;
+
+// 封存块索引项
+typedef struct {
+    int64_t firstTime;       // 块内第一条记录的开始时间（解码基准）
+    int64_t minTime;         // 块内最早的开始时间
+    int64_t maxTime;         // 块内最晚的开始时间
+    uint64_t lastSequence;   // 块内最后一条记录的追加序号
+    uint32_t offset;         // 块在数据文件中的偏移
+    uint32_t length;         // 块的编码长度
+    uint32_t count;          // 块内记录数
+    uint32_t checksum;       // 块数据的FNV-1a校验值
+} HistoryBlockIndex;
+
+// 归档文件路径
+typedef struct {
+    HistoryChar dataPath[HISTORY_PATH_MAX];      // 封存块数据
+    HistoryChar indexPath[HISTORY_PATH_MAX];     // 块索引
+    HistoryChar logPath[HISTORY_PATH_MAX];       // 新记录追加日志
+    HistoryChar pendingPath[HISTORY_PATH_MAX];   // 正在压缩的日志
+    HistoryChar stagePath[HISTORY_PATH_MAX];     // 不足一块的暂存记录
+    HistoryChar stageTmpPath[HISTORY_PATH_MAX];  // 暂存记录的临时文件
+    uint64_t nextSequence;                        // 下一条记录的追加序号（仅追加线程使用）
+    HistoryLock logLock;                          // 日志追加与改名交接互斥
+} HistoryArchive;
+
+// 范围查询回调
+typedef void (*HistoryVisitFn)(const SessionRecord* record, void* context);
+
+// 初始化归档路径，修复中断追加留下的残缺日志，并从已有文件恢复追加序号
+// directory 需以路径分隔符结尾；成功返回0，之后需调用 HistoryClose
+int HistoryInit(HistoryArchive* archive, const HistoryChar* directory);
+
+// 释放 HistoryInit 创建的资源，调用前需确保没有线程仍在使用该归档
+void HistoryClose(HistoryArchive* archive);
+
+// 追加一条记录到日志（UI线程调用，开销为一次小文件追加）；成功返回0
+int HistoryAppend(HistoryArchive* archive, const SessionRecord* record);
+
+// 将日志中的记录合并到暂存区，并把满块封存到数据文件；成功返回0
+// 只能由单个后台线程调用，可与 HistoryAppend 并发：日志改名与追加由 logLock 互斥，
+// 追加最多等待一次改名，不会等待编码和封存
+int HistoryCompact(HistoryArchive* archive);
+
+// 按开始时间查询 [from, to] 内的记录，只读取时间范围重叠的封存块；返回记录数，失败返回-1
+// 校验或解码失败的块被跳过，个数写入 skippedBlocks（可为NULL）
+// 不使用共享缓冲区；但与 HistoryCompact 并发时可能漏掉正在封存的记录，
+// 需要完整结果时应在压缩线程上、两次压缩之间调用
+long HistoryQueryRange(const HistoryArchive* archive, int64_t from, int64_t to,
+                       HistoryVisitFn visit, void* context, uint32_t* skippedBlocks);
+
+// 编码一个块，out 至少需要 count * HISTORY_MAX_RECORD_BYTES 字节；返回编码长度
+size_t HistoryEncodeBlock(const SessionRecord* records, uint32_t count, uint8_t* out);
+
+// 解码一个块；成功返回0，数据损坏返回-1
+int HistoryDecodeBlock(const uint8_t* data, size_t length, int64_t firstTime,
+                       uint32_t count, SessionRecord* out);
+
+#endif // POMODORO_HISTORY_H
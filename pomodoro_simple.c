@@ -1,6 +1,9 @@
 #include <windows.h>
 #include <shellapi.h>
 #include <stdio.h>
+#include <time.h>
+#include "pomodoro_format.h"
+#include "pomodoro_history.h"
 
 // 计时器状态
 typedef struct {
@@ -32,6 +35,15 @@ typedef struct {
     BOOL isSettingsButtonHovered;  // 设置按钮悬停状态
     int tempWorkMinutes;   // 临时工作时长（分钟）
     int tempBreakMinutes;  // 临时休息时长（分钟）
+    StringId shownStatusId;    // 状态标签当前显示的字符串
+    StringId shownTrayTipId;   // 托盘提示当前显示的字符串
+    HistoryArchive history;    // 历史归档路径
+    BOOL isHistoryReady;       // 历史归档是否可用
+    int64_t phaseStartTime;    // 当前阶段开始时间(Unix秒)，0表示未开始
+    int phasePlannedSeconds;   // 当前阶段开始时的计划时长(秒)
+    HANDLE hCompactThread;     // 后台压缩线程
+    HANDLE hCompactEvent;      // 通知压缩线程有新记录
+    HANDLE hStopEvent;         // 通知压缩线程退出
 } AppData;
 
 // 全局变量
@@ -65,20 +77,17 @@ void PauseTimer();
 void ResetTimer();
 void SaveSettingsToINI();
 void LoadSettingsFromINI();
+void LoadLanguageFromINI();
 void ShowNotification(const wchar_t* title, const wchar_t* message);
 void ShowMainView();
 void ShowSettingsView();
 void SaveSettings();
+void RecordCompletedPhase();
+void StartHistoryCompactor();
+void StopHistoryCompactor();
+int MeasureTextWidth(HWND hControl, const wchar_t* text);
 
 
-
-// 格式化时间字符串
-void FormatTime(int seconds, wchar_t* buffer, int bufferSize) {
-    int minutes = seconds / 60;
-    int secs = seconds % 60;
-    swprintf_s(buffer, bufferSize, L"%02d:%02d", minutes, secs);
-}
-
 // 窗口过程
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
     switch (uMsg) {
@@ -94,10 +103,15 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
     g_app.isSettingsButtonHovered = FALSE;  // 初始化悬停状态
     g_app.tempWorkMinutes = 27;
     g_app.tempBreakMinutes = 3;
+            g_app.shownStatusId = STR_COUNT;
+            g_app.shownTrayTipId = STR_COUNT;
             
             // 加载保存的设置
             LoadSettingsFromINI();
             
+            // 启动历史归档后台压缩
+            StartHistoryCompactor();
+            
             // 创建时间标签 - 使用新的深色配色
             g_app.hTimeLabel = CreateWindowW(
                 L"STATIC", L"00:00",
@@ -117,15 +131,41 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             
             // 创建状态标签 - 使用新的深色配色
             g_app.hStatusLabel = CreateWindowW(
-                L"STATIC", L"工作中 - 点击开始",
+                L"STATIC", L"",
                 WS_CHILD | WS_VISIBLE | SS_CENTER,
                 10, 90, 180, 20,  // 调整位置
                 hwnd, NULL, GetModuleHandle(NULL), NULL
             );
             
+            // 设置状态标签字体（明确指定字体，宽度才能按实际文字测量）
+            HFONT hStatusFont = CreateFontW(14, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+                DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+                DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Segoe UI");
+            SendMessageW(g_app.hStatusLabel, WM_SETFONT, (WPARAM)hStatusFont, FALSE);
+            
+            // 按最长的状态文字加宽标签（保持居中，不超出窗口）
+            const StringId statusIds[] = {
+                STR_STATUS_WORK, STR_STATUS_WORK_PAUSED, STR_STATUS_BREAK, STR_STATUS_BREAK_PAUSED
+            };
+            int statusWidth = 180;
+            for (int i = 0; i < 4; i++) {
+                int width = MeasureTextWidth(g_app.hStatusLabel, FormatGetString(statusIds[i])) + 4;
+                if (width > statusWidth) statusWidth = width;
+            }
+            RECT clientRect;
+            GetClientRect(hwnd, &clientRect);
+            if (statusWidth > clientRect.right) statusWidth = clientRect.right;
+            if (statusWidth > 180) {
+                int statusX = 100 - statusWidth / 2;
+                if (statusX < 0) statusX = 0;
+                SetWindowPos(g_app.hStatusLabel, NULL, statusX, 90, statusWidth, 20,
+                    SWP_NOZORDER | SWP_NOACTIVATE);
+            }
+            UpdateTimerDisplay();
+            
             // 创建提示标签
             HWND hHintLabel = CreateWindowW(
-                L"STATIC", L"点击窗口开始计时",
+                L"STATIC", FormatGetString(STR_HINT_START),
                 WS_CHILD | WS_VISIBLE | SS_CENTER,
                 10, 115, 180, 15,  // 新增提示标签
                 hwnd, NULL, GetModuleHandle(NULL), NULL
@@ -139,7 +179,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
             
             // 创建设置按钮（文字按钮样式）
             g_app.hSettingsButton = CreateWindowW(
-                L"STATIC", L"设置",  // 使用STATIC控件实现文字按钮
+                L"STATIC", FormatGetString(STR_SETTINGS),  // 使用STATIC控件实现文字按钮
                 WS_CHILD | WS_VISIBLE | SS_CENTER | SS_NOTIFY,
                 150, 10, 40, 20,  // 右上角位置，稍小一些
                 hwnd, (HMENU)ID_SETTINGS_BUTTON, GetModuleHandle(NULL), NULL
@@ -150,6 +190,12 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                 OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH | FF_SWISS, L"Segoe UI");
             SendMessageW(g_app.hSettingsButton, WM_SETFONT, (WPARAM)hLinkFont, TRUE);
             
+            // 按文字宽度调整按钮，右边缘保持在190
+            int settingsWidth = MeasureTextWidth(g_app.hSettingsButton, FormatGetString(STR_SETTINGS)) + 6;
+            if (settingsWidth < 40) settingsWidth = 40;
+            SetWindowPos(g_app.hSettingsButton, NULL, 190 - settingsWidth, 10, settingsWidth, 20,
+                SWP_NOZORDER | SWP_NOACTIVATE);
+            
             // 创建托盘图标
             CreateTrayIcon(hwnd);
             
@@ -349,7 +395,7 @@ void CreateMainWindow(HINSTANCE hInstance) {
     
     g_app.hWnd = CreateWindowExW(
         WS_EX_TOOLWINDOW | WS_EX_TOPMOST,
-        g_className, L"番茄钟",
+        g_className, FormatGetString(STR_APP_TITLE),
         WS_POPUP | WS_VISIBLE, // 去掉标题栏，使用无边框窗口
         CW_USEDEFAULT, CW_USEDEFAULT, 220, 200,  // 窗口尺寸
         NULL, NULL, hInstance, NULL
@@ -368,8 +414,8 @@ void CreateTrayIcon(HWND hWnd) {
     if (!g_app.nid.hIcon) {
         g_app.nid.hIcon = LoadIconW(NULL, IDI_APPLICATION); // 如果加载失败，使用默认图标
     }
-    wcsncpy(g_app.nid.szTip, L"番茄钟 - 工作中", sizeof(g_app.nid.szTip)/sizeof(wchar_t) - 1);
-    g_app.nid.szTip[sizeof(g_app.nid.szTip)/sizeof(wchar_t) - 1] = L'\0';
+    g_app.shownTrayTipId = g_app.timer.isWorking ? STR_TRAY_WORK : STR_TRAY_BREAK;
+    FormatCopyString(g_app.shownTrayTipId, g_app.nid.szTip, sizeof(g_app.nid.szTip)/sizeof(wchar_t));
     
     Shell_NotifyIconW(NIM_ADD, &g_app.nid);
 }
@@ -384,14 +430,14 @@ void ShowTrayMenu(HWND hWnd) {
     HMENU hMenu = CreatePopupMenu();
     
     if (g_app.timer.isRunning && !g_app.timer.isPaused) {
-        AppendMenuW(hMenu, MF_STRING, ID_TRAY_START, L"暂停");
+        AppendMenuW(hMenu, MF_STRING, ID_TRAY_START, FormatGetString(STR_MENU_PAUSE));
     } else {
-        AppendMenuW(hMenu, MF_STRING, ID_TRAY_START, L"开始");
+        AppendMenuW(hMenu, MF_STRING, ID_TRAY_START, FormatGetString(STR_MENU_START));
     }
     
-    AppendMenuW(hMenu, MF_STRING, ID_TRAY_RESET, L"重置");
+    AppendMenuW(hMenu, MF_STRING, ID_TRAY_RESET, FormatGetString(STR_MENU_RESET));
     AppendMenuW(hMenu, MF_SEPARATOR, 0, NULL);
-    AppendMenuW(hMenu, MF_STRING, ID_TRAY_EXIT, L"退出");
+    AppendMenuW(hMenu, MF_STRING, ID_TRAY_EXIT, FormatGetString(STR_MENU_EXIT));
     
     POINT pt;
     GetCursorPos(&pt);
@@ -401,32 +447,57 @@ void ShowTrayMenu(HWND hWnd) {
     DestroyMenu(hMenu);
 }
 
+// 测量文字在控件当前字体下的像素宽度
+int MeasureTextWidth(HWND hControl, const wchar_t* text) {
+    HDC hdc = GetDC(hControl);
+    if (!hdc) {
+        return 0;
+    }
+    HFONT hFont = (HFONT)SendMessageW(hControl, WM_GETFONT, 0, 0);
+    HGDIOBJ hOldFont = hFont ? SelectObject(hdc, hFont) : NULL;
+    SIZE size = {0, 0};
+    GetTextExtentPoint32W(hdc, text, (int)wcslen(text), &size);
+    if (hOldFont) {
+        SelectObject(hdc, hOldFont);
+    }
+    ReleaseDC(hControl, hdc);
+    return size.cx;
+}
+
 // 更新计时器显示
 void UpdateTimerDisplay() {
-    wchar_t timeStr[32];
-    FormatTime(g_app.timer.remainingTime, timeStr, 32);
+    wchar_t timeStr[FORMAT_CLOCK_MAX];
+    FormatClock(g_app.timer.remainingTime, FORMAT_CLOCK_MINUTES, timeStr);
     SetWindowTextW(g_app.hTimeLabel, timeStr);
     
-    const wchar_t* statusText = g_app.timer.isWorking ? 
-        (g_app.timer.isPaused ? L"工作中 - 点击开始" : L"工作中") :
-        (g_app.timer.isPaused ? L"休息中 - 点击开始" : L"休息中");
-    SetWindowTextW(g_app.hStatusLabel, statusText);
+    // 状态文字只在变化时更新
+    StringId statusId = g_app.timer.isWorking ?
+        (g_app.timer.isPaused ? STR_STATUS_WORK_PAUSED : STR_STATUS_WORK) :
+        (g_app.timer.isPaused ? STR_STATUS_BREAK_PAUSED : STR_STATUS_BREAK);
+    if (g_app.hStatusLabel && statusId != g_app.shownStatusId) {
+        SetWindowTextW(g_app.hStatusLabel, FormatGetString(statusId));
+        g_app.shownStatusId = statusId;
+    }
     
-    // 更新托盘提示
-    const wchar_t* trayTip = g_app.timer.isWorking ? L"番茄钟 - 工作中" : L"番茄钟 - 休息中";
-    wcsncpy(g_app.nid.szTip, trayTip, sizeof(g_app.nid.szTip)/sizeof(wchar_t) - 1);
-    g_app.nid.szTip[sizeof(g_app.nid.szTip)/sizeof(wchar_t) - 1] = L'\0';
-    Shell_NotifyIconW(NIM_MODIFY, &g_app.nid);
+    // 托盘提示只在工作/休息切换时更新
+    StringId trayTipId = g_app.timer.isWorking ? STR_TRAY_WORK : STR_TRAY_BREAK;
+    if (g_app.nid.cbSize && trayTipId != g_app.shownTrayTipId) {
+        FormatCopyString(trayTipId, g_app.nid.szTip, sizeof(g_app.nid.szTip)/sizeof(wchar_t));
+        Shell_NotifyIconW(NIM_MODIFY, &g_app.nid);
+        g_app.shownTrayTipId = trayTipId;
+    }
 }
 
 // 切换计时器模式
 void SwitchTimerMode() {
+    RecordCompletedPhase();
+    
     g_app.timer.isWorking = !g_app.timer.isWorking;
     g_app.timer.remainingTime = g_app.timer.isWorking ? 
         g_app.timer.workDuration : g_app.timer.breakDuration;
     
-    const wchar_t* title = L"番茄钟";
-    const wchar_t* message = g_app.timer.isWorking ? L"休息结束，开始工作！" : L"开始休息！";
+    const wchar_t* title = FormatGetString(STR_APP_TITLE);
+    const wchar_t* message = FormatGetString(g_app.timer.isWorking ? STR_NOTIFY_WORK : STR_NOTIFY_BREAK);
     ShowNotification(title, message);
     
     UpdateTimerDisplay();
@@ -434,6 +505,11 @@ void SwitchTimerMode() {
 
 // 开始计时器
 void StartTimer() {
+    if (g_app.phaseStartTime == 0) {
+        g_app.phaseStartTime = (int64_t)time(NULL);
+        g_app.phasePlannedSeconds = g_app.timer.isWorking ?
+            g_app.timer.workDuration : g_app.timer.breakDuration;
+    }
     g_app.timer.isRunning = TRUE;
     g_app.timer.isPaused = FALSE;
     SetTimer(g_app.hWnd, ID_TIMER, 1000, NULL);
@@ -453,10 +529,101 @@ void ResetTimer() {
     g_app.timer.isPaused = TRUE;
     g_app.timer.isWorking = TRUE;
     g_app.timer.remainingTime = g_app.timer.workDuration;
+    g_app.phaseStartTime = 0;  // 未完成的阶段不记录
     KillTimer(g_app.hWnd, ID_TIMER);
     UpdateTimerDisplay();
 }
 
+// 记录刚完成的阶段并开始计时下一阶段（在切换模式前调用）
+void RecordCompletedPhase() {
+    int64_t now = (int64_t)time(NULL);
+    
+    if (g_app.isHistoryReady && g_app.phaseStartTime != 0 && now >= g_app.phaseStartTime) {
+        SessionRecord record;
+        record.startTime = g_app.phaseStartTime;
+        record.plannedSeconds = (uint32_t)g_app.phasePlannedSeconds;
+        record.elapsedSeconds = (uint32_t)(now - g_app.phaseStartTime);
+        record.isWorking = g_app.timer.isWorking ? 1 : 0;
+        
+        // 只追加到日志，编码和封存交给后台线程
+        if (HistoryAppend(&g_app.history, &record) == 0 && g_app.hCompactEvent) {
+            SetEvent(g_app.hCompactEvent);
+        }
+    }
+    
+    // 下一阶段紧接着开始，计划时长在此刻确定，之后修改设置不影响本阶段的记录
+    g_app.phaseStartTime = now;
+    g_app.phasePlannedSeconds = g_app.timer.isWorking ?
+        g_app.timer.breakDuration : g_app.timer.workDuration;
+}
+
+// 后台压缩线程
+DWORD WINAPI CompactThreadProc(LPVOID param) {
+    UNREFERENCED_PARAMETER(param);
+    
+    // 降低CPU和I/O优先级，避免影响界面
+    // THREAD_MODE_BACKGROUND_BEGIN 需要 _WIN32_WINNT >= 0x0600，旧头文件只降低CPU优先级
+#ifdef THREAD_MODE_BACKGROUND_BEGIN
+    if (!SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN)) {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+    }
+#else
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#endif
+    
+    HANDLE handles[2] = { g_app.hStopEvent, g_app.hCompactEvent };
+    while (WaitForMultipleObjects(2, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1) {
+        HistoryCompact(&g_app.history);
+    }
+    return 0;
+}
+
+// 启动历史归档后台压缩
+void StartHistoryCompactor() {
+    wchar_t directory[MAX_PATH];
+    GetModuleFileNameW(NULL, directory, MAX_PATH);
+    wchar_t* lastSlash = wcsrchr(directory, L'\\');
+    if (!lastSlash) {
+        return;
+    }
+    *(lastSlash + 1) = L'\0';
+    
+    if (HistoryInit(&g_app.history, directory) != 0) {
+        return;
+    }
+    g_app.isHistoryReady = TRUE;
+    
+    g_app.hStopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    g_app.hCompactEvent = CreateEventW(NULL, FALSE, TRUE, NULL);  // 启动时先整理一次
+    if (g_app.hStopEvent && g_app.hCompactEvent) {
+        g_app.hCompactThread = CreateThread(NULL, 0, CompactThreadProc, NULL, 0, NULL);
+    }
+}
+
+// 停止后台压缩线程
+void StopHistoryCompactor() {
+    BOOL isStopped = TRUE;
+    if (g_app.hCompactThread) {
+        SetEvent(g_app.hStopEvent);
+        isStopped = WaitForSingleObject(g_app.hCompactThread, 5000) == WAIT_OBJECT_0;
+        CloseHandle(g_app.hCompactThread);
+        g_app.hCompactThread = NULL;
+    }
+    // 压缩线程未能及时退出时仍在使用归档，此时不释放
+    if (g_app.isHistoryReady && isStopped) {
+        HistoryClose(&g_app.history);
+        g_app.isHistoryReady = FALSE;
+    }
+    if (g_app.hCompactEvent) {
+        CloseHandle(g_app.hCompactEvent);
+        g_app.hCompactEvent = NULL;
+    }
+    if (g_app.hStopEvent) {
+        CloseHandle(g_app.hStopEvent);
+        g_app.hStopEvent = NULL;
+    }
+}
+
 // 显示系统通知
 void ShowNotification(const wchar_t* title, const wchar_t* message) {
     // 使用Windows 10/11的通知API
@@ -510,7 +677,7 @@ void ShowSettingsView() {
     if (!g_app.hWorkEdit) {
         // 工作时长标签
         g_app.hWorkLabel = CreateWindowW(
-            L"STATIC", L"工作时长（分钟）:",
+            L"STATIC", FormatGetString(STR_WORK_MINUTES),
             WS_CHILD | WS_VISIBLE,
             10, 20, 180, 20,
             g_app.hWnd, NULL, GetModuleHandle(NULL), NULL
@@ -528,7 +695,7 @@ void ShowSettingsView() {
         
         // 休息时长标签
         g_app.hBreakLabel = CreateWindowW(
-            L"STATIC", L"休息时长（分钟）:",
+            L"STATIC", FormatGetString(STR_BREAK_MINUTES),
             WS_CHILD | WS_VISIBLE,
             10, 70, 180, 20,
             g_app.hWnd, NULL, GetModuleHandle(NULL), NULL
@@ -546,7 +713,7 @@ void ShowSettingsView() {
         
         // 保存按钮
         g_app.hSaveButton = CreateWindowW(
-            L"BUTTON", L"保存",
+            L"BUTTON", FormatGetString(STR_SAVE),
             WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
             10, 125, 85, 30,
             g_app.hWnd, (HMENU)ID_SAVE_BUTTON, GetModuleHandle(NULL), NULL
@@ -554,7 +721,7 @@ void ShowSettingsView() {
         
         // 取消按钮
         g_app.hCancelButton = CreateWindowW(
-            L"BUTTON", L"取消",
+            L"BUTTON", FormatGetString(STR_CANCEL),
             WS_CHILD | WS_VISIBLE | BS_PUSHBUTTON,
             105, 125, 85, 30,
             g_app.hWnd, (HMENU)ID_CANCEL_BUTTON, GetModuleHandle(NULL), NULL
@@ -631,6 +798,21 @@ void LoadSettingsFromINI() {
     }
 }
 
+// 从INI文件加载界面语言（需在创建窗口前调用）
+void LoadLanguageFromINI() {
+    wchar_t iniPath[MAX_PATH];
+    GetModuleFileNameW(NULL, iniPath, MAX_PATH);
+    wchar_t* lastSlash = wcsrchr(iniPath, L'\\');
+    if (lastSlash) {
+        *(lastSlash + 1) = L'\0';
+        wcscat_s(iniPath, MAX_PATH, L"pomodoro_settings.ini");
+    }
+    
+    wchar_t language[16];
+    GetPrivateProfileStringW(L"Settings", L"Language", L"zh-CN", language, 16, iniPath);
+    FormatSelectLanguage(FormatLanguageFromName(language));
+}
+
 // 保存设置
 void SaveSettings() {
     wchar_t workBuffer[10];
@@ -644,7 +826,7 @@ void SaveSettings() {
     
     // 验证输入
     if (workMinutes <= 0 || workMinutes > 120 || breakMinutes <= 0 || breakMinutes > 60) {
-        MessageBoxW(g_app.hWnd, L"请输入有效的时间范围（工作: 1-120分钟，休息: 1-60分钟）", L"输入错误", MB_OK | MB_ICONWARNING);
+        MessageBoxW(g_app.hWnd, FormatGetString(STR_INPUT_ERROR), FormatGetString(STR_INPUT_ERROR_TITLE), MB_OK | MB_ICONWARNING);
         return;
     }
     
@@ -676,6 +858,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
     UNREFERENCED_PARAMETER(lpCmdLine);
     UNREFERENCED_PARAMETER(nCmdShow);
     
+    // 选择界面语言
+    LoadLanguageFromINI();
+    
     // 创建主窗口
     CreateMainWindow(hInstance);
     
@@ -686,5 +871,8 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance,
         DispatchMessage(&msg);
     }
     
+    // 等待后台压缩结束
+    StopHistoryCompactor();
+    
     return (int)msg.wParam;
 }
\ No newline at end of file
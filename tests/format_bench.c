@@ -0,0 +1,47 @@
+// 文本格式化基准测试（Linux）：FormatClock 与原来的 printf 路径对比
+// gcc -std=c99 -O2 -I. -o format_bench tests/format_bench.c pomodoro_format.c && ./format_bench
+// Linux 没有 swprintf_s，用格式串相同的 swprintf 代替
+#define _POSIX_C_SOURCE 200809L
+
+#include "pomodoro_format.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+
+#define MAX_SESSION_SECONDS (120 * 60)
+#define BENCH_ROUNDS 2000
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+int main(void) {
+    wchar_t buffer[FORMAT_CLOCK_MAX];
+    volatile unsigned long sink = 0;
+    long calls = (long)BENCH_ROUNDS * (MAX_SESSION_SECONDS + 1);
+
+    double start = NowSeconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int seconds = 0; seconds <= MAX_SESSION_SECONDS; seconds++) {
+            sink += FormatClock(seconds, FORMAT_CLOCK_MINUTES, buffer) + (unsigned long)buffer[4];
+        }
+    }
+    double tableSeconds = NowSeconds() - start;
+
+    start = NowSeconds();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int seconds = 0; seconds <= MAX_SESSION_SECONDS; seconds++) {
+            sink += (unsigned long)swprintf(buffer, FORMAT_CLOCK_MAX, L"%02d:%02d",
+                                            seconds / 60, seconds % 60) + (unsigned long)buffer[4];
+        }
+    }
+    double printfSeconds = NowSeconds() - start;
+
+    printf("FormatClock: %6.1f ns/call\n", tableSeconds / calls * 1e9);
+    printf("swprintf:    %6.1f ns/call\n", printfSeconds / calls * 1e9);
+    printf("speedup:     %6.1fx\n", printfSeconds / tableSeconds);
+    return (int)(sink & 0);
+}
@@ -0,0 +1,110 @@
+// 文本格式化测试（Linux）
+// gcc -std=c99 -O2 -I. -o format_test tests/format_test.c pomodoro_format.c && ./format_test
+#undef NDEBUG
+
+#include "pomodoro_format.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <wchar.h>
+
+#define MAX_SESSION_SECONDS (120 * 60)
+
+static void ExpectClock(int seconds, FormatClockStyle style, const wchar_t* expected) {
+    wchar_t buffer[FORMAT_CLOCK_MAX];
+    size_t length = FormatClock(seconds, style, buffer);
+    assert(wcscmp(buffer, expected) == 0);
+    assert(length == wcslen(expected));
+}
+
+// 与原来的 swprintf_s(L"%02d:%02d") 逐值比较
+static void TestMinutesMatchesPrintf(void) {
+    wchar_t expected[32];
+    for (int seconds = 0; seconds <= MAX_SESSION_SECONDS; seconds++) {
+        swprintf(expected, 32, L"%02d:%02d", seconds / 60, seconds % 60);
+        ExpectClock(seconds, FORMAT_CLOCK_MINUTES, expected);
+    }
+}
+
+static void TestHoursStyle(void) {
+    wchar_t expected[32];
+    for (int seconds = 0; seconds < 3600; seconds++) {
+        swprintf(expected, 32, L"%02d:%02d", seconds / 60, seconds % 60);
+        ExpectClock(seconds, FORMAT_CLOCK_HOURS, expected);
+    }
+    for (int seconds = 3600; seconds <= MAX_SESSION_SECONDS; seconds++) {
+        swprintf(expected, 32, L"%d:%02d:%02d", seconds / 3600, seconds / 60 % 60, seconds % 60);
+        ExpectClock(seconds, FORMAT_CLOCK_HOURS, expected);
+    }
+    ExpectClock(3600, FORMAT_CLOCK_HOURS, L"1:00:00");
+    ExpectClock(36000, FORMAT_CLOCK_HOURS, L"10:00:00");
+    ExpectClock(99 * 3600 + 59 * 60 + 59, FORMAT_CLOCK_HOURS, L"99:59:59");
+}
+
+static void TestClamping(void) {
+    ExpectClock(-1, FORMAT_CLOCK_MINUTES, L"00:00");
+    ExpectClock(-86400, FORMAT_CLOCK_HOURS, L"00:00");
+    ExpectClock(999 * 60 + 59, FORMAT_CLOCK_MINUTES, L"999:59");
+    ExpectClock(1000 * 60, FORMAT_CLOCK_MINUTES, L"999:59");
+    ExpectClock(100 * 3600, FORMAT_CLOCK_HOURS, L"99:59:59");
+    ExpectClock(2147483647, FORMAT_CLOCK_MINUTES, L"999:59");
+    ExpectClock(2147483647, FORMAT_CLOCK_HOURS, L"99:59:59");
+}
+
+static void TestCopyString(void) {
+    FormatSelectLanguage(FORMAT_LANG_EN);
+
+    wchar_t buffer[64];
+    assert(FormatCopyString(STR_TRAY_WORK, buffer, 64) == wcslen(L"Pomodoro - Working"));
+    assert(wcscmp(buffer, L"Pomodoro - Working") == 0);
+
+    // 截断时保留结尾的空字符
+    assert(FormatCopyString(STR_TRAY_WORK, buffer, 5) == 4);
+    assert(wcscmp(buffer, L"Pomo") == 0);
+    assert(FormatCopyString(STR_TRAY_WORK, buffer, 1) == 0);
+    assert(buffer[0] == L'\0');
+
+    // 容量为0时不写入
+    buffer[0] = L'x';
+    assert(FormatCopyString(STR_TRAY_WORK, buffer, 0) == 0);
+    assert(buffer[0] == L'x');
+
+    FormatSelectLanguage(FORMAT_LANG_ZH_CN);
+    assert(FormatCopyString(STR_TRAY_BREAK, buffer, 64) == wcslen(L"番茄钟 - 休息中"));
+    assert(wcscmp(buffer, L"番茄钟 - 休息中") == 0);
+}
+
+static void TestLanguages(void) {
+    assert(FormatLanguageFromName(L"en") == FORMAT_LANG_EN);
+    assert(FormatLanguageFromName(L"EN") == FORMAT_LANG_EN);
+    assert(FormatLanguageFromName(L"en-US") == FORMAT_LANG_EN);
+    assert(FormatLanguageFromName(L"en_GB") == FORMAT_LANG_EN);
+    assert(FormatLanguageFromName(L"zh-CN") == FORMAT_LANG_ZH_CN);
+    assert(FormatLanguageFromName(L"english") == FORMAT_LANG_ZH_CN);
+    assert(FormatLanguageFromName(L"e") == FORMAT_LANG_ZH_CN);
+    assert(FormatLanguageFromName(L"") == FORMAT_LANG_ZH_CN);
+    assert(FormatLanguageFromName(NULL) == FORMAT_LANG_ZH_CN);
+
+    // 每种语言的每个字符串都非空
+    for (int language = 0; language < FORMAT_LANG_COUNT; language++) {
+        FormatSelectLanguage((FormatLanguage)language);
+        for (int id = 0; id < STR_COUNT; id++) {
+            assert(FormatGetString((StringId)id)[0] != L'\0');
+        }
+    }
+
+    FormatSelectLanguage(FORMAT_LANG_EN);
+    assert(wcscmp(FormatGetString(STR_MENU_EXIT), L"Exit") == 0);
+    FormatSelectLanguage((FormatLanguage)FORMAT_LANG_COUNT);
+    assert(wcscmp(FormatGetString(STR_MENU_EXIT), L"退出") == 0);
+}
+
+int main(void) {
+    TestMinutesMatchesPrintf();
+    TestHoursStyle();
+    TestClamping();
+    TestCopyString();
+    TestLanguages();
+    printf("format_test: all tests passed\n");
+    return 0;
+}
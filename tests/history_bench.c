@@ -0,0 +1,157 @@
+// 历史归档基准测试（Linux）：10年模拟数据的存储密度、编解码吞吐量和范围查询延迟
+// gcc -std=c99 -O2 -I. -o history_bench tests/history_bench.c pomodoro_history.c -pthread && ./history_bench
+#define _POSIX_C_SOURCE 200809L
+
+#include "pomodoro_history.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_YEARS 10
+#define BENCH_CODEC_ROUNDS 2000
+#define BENCH_QUERY_ROUNDS 1000
+
+static double NowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static long FileSize(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// 生成模拟数据：工作日每天8-15个阶段，工作/休息交替，偶有暂停和长间隔
+static size_t GenerateSessions(SessionRecord** out) {
+    size_t capacity = (size_t)BENCH_YEARS * 366 * 16;
+    SessionRecord* records = malloc(capacity * sizeof(SessionRecord));
+    size_t count = 0;
+    int64_t dayStart = 1420070400;  // 2015-01-01
+
+    srand(1);
+    for (int day = 0; day < BENCH_YEARS * 365; day++, dayStart += 86400) {
+        if (day % 7 >= 5) continue;
+        int64_t t = dayStart + 9 * 3600 + rand() % 600;
+        int phases = 8 + rand() % 8;
+        for (int i = 0; i < phases; i++) {
+            SessionRecord* r = &records[count++];
+            r->isWorking = i % 2 == 0;
+            r->plannedSeconds = r->isWorking ? 27 * 60 : 3 * 60;
+            r->elapsedSeconds = r->plannedSeconds + 1 + (rand() % 10 == 0 ? rand() % 300 : 0);
+            r->startTime = t;
+            t += r->elapsedSeconds + (rand() % 5 == 0 ? rand() % 3600 : 0);
+        }
+    }
+    *out = records;
+    return count;
+}
+
+static void BenchCodec(const SessionRecord* records, size_t count) {
+    static uint8_t encoded[HISTORY_BLOCK_RECORDS * HISTORY_MAX_RECORD_BYTES];
+    static SessionRecord decoded[HISTORY_BLOCK_RECORDS];
+    size_t blocks = count / HISTORY_BLOCK_RECORDS;
+    size_t totalBytes = 0;
+
+    double start = NowSeconds();
+    for (int i = 0; i < BENCH_CODEC_ROUNDS; i++) {
+        totalBytes += HistoryEncodeBlock(records + (i % blocks) * HISTORY_BLOCK_RECORDS,
+                                         HISTORY_BLOCK_RECORDS, encoded);
+    }
+    double encodeSeconds = NowSeconds() - start;
+
+    size_t length = HistoryEncodeBlock(records, HISTORY_BLOCK_RECORDS, encoded);
+    start = NowSeconds();
+    for (int i = 0; i < BENCH_CODEC_ROUNDS; i++) {
+        if (HistoryDecodeBlock(encoded, length, records[0].startTime,
+                               HISTORY_BLOCK_RECORDS, decoded) != 0) {
+            fprintf(stderr, "decode failed\n");
+            exit(1);
+        }
+    }
+    double decodeSeconds = NowSeconds() - start;
+
+    double recordsDone = (double)BENCH_CODEC_ROUNDS * HISTORY_BLOCK_RECORDS;
+    printf("encode:  %8.1f M records/s  (%.1f MB/s out)\n",
+           recordsDone / encodeSeconds / 1e6, (double)totalBytes / encodeSeconds / 1e6);
+    printf("decode:  %8.1f M records/s\n", recordsDone / decodeSeconds / 1e6);
+}
+
+static void BenchQuery(const HistoryArchive* archive, const SessionRecord* records,
+                       size_t count, const char* label, int64_t span) {
+    int64_t first = records[0].startTime;
+    int64_t range = records[count - 1].startTime - first - span;
+    long visited = 0;
+
+    srand(2);
+    double start = NowSeconds();
+    for (int i = 0; i < BENCH_QUERY_ROUNDS; i++) {
+        int64_t from = first + (range > 0 ? (int64_t)((double)rand() / RAND_MAX * range) : 0);
+        uint32_t skipped;
+        long result = HistoryQueryRange(archive, from, from + span, NULL, NULL, &skipped);
+        if (result < 0 || skipped != 0) {
+            fprintf(stderr, "query failed\n");
+            exit(1);
+        }
+        visited += result;
+    }
+    double seconds = NowSeconds() - start;
+    printf("query %-6s %8.1f us  (%ld records avg)\n", label,
+           seconds / BENCH_QUERY_ROUNDS * 1e6, visited / BENCH_QUERY_ROUNDS);
+}
+
+int main(void) {
+    char dir[] = "/tmp/pomodoro_history_bench_XXXXXX";
+    char prefix[64];
+    if (!mkdtemp(dir)) return 1;
+    snprintf(prefix, sizeof(prefix), "%s/", dir);
+
+    SessionRecord* records;
+    size_t count = GenerateSessions(&records);
+    printf("%d years, %zu sessions\n", BENCH_YEARS, count);
+
+    BenchCodec(records, count);
+
+    // 按应用的方式写入：每条记录追加到日志，约每天（12条记录）压缩一次
+    HistoryArchive archive;
+    if (HistoryInit(&archive, prefix) != 0) return 1;
+    double start = NowSeconds();
+    for (size_t i = 0; i < count; i++) {
+        if (HistoryAppend(&archive, &records[i]) != 0) return 1;
+        if (i % 12 == 11 && HistoryCompact(&archive) != 0) return 1;
+    }
+    if (HistoryCompact(&archive) != 0) return 1;
+    double ingestSeconds = NowSeconds() - start;
+
+    long dataBytes = FileSize(archive.dataPath);
+    long indexBytes = FileSize(archive.indexPath);
+    long stageBytes = FileSize(archive.stagePath);
+    size_t sealed = count - (size_t)stageBytes / HISTORY_RAW_RECORD_BYTES;
+    printf("ingest:  %8.1f ms total (append + compaction)\n", ingestSeconds * 1e3);
+    printf("storage: %ld B blocks + %ld B index + %ld B stage\n", dataBytes, indexBytes, stageBytes);
+    printf("bytes/session: %.2f in blocks, %.2f with index (raw record %d)\n",
+           (double)dataBytes / sealed, (double)(dataBytes + indexBytes) / sealed,
+           HISTORY_RAW_RECORD_BYTES);
+
+    BenchQuery(&archive, records, count, "day", 86400);
+    BenchQuery(&archive, records, count, "week", 7 * 86400);
+    BenchQuery(&archive, records, count, "month", 30 * 86400);
+    BenchQuery(&archive, records, count, "year", 365 * 86400);
+    HistoryClose(&archive);
+
+    const char* names[] = {"dat", "idx", "log", "pending", "stage", "stage.tmp"};
+    char path[128];
+    for (int i = 0; i < 6; i++) {
+        snprintf(path, sizeof(path), "%spomodoro_history.%s", prefix, names[i]);
+        remove(path);
+    }
+    rmdir(dir);
+    free(records);
+    return 0;
+}
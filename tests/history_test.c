@@ -0,0 +1,446 @@
+// 历史归档测试（Linux）
+// gcc -std=c99 -O2 -I. -o history_test tests/history_test.c pomodoro_history.c -pthread && ./history_test
+#define _POSIX_C_SOURCE 200809L
+#undef NDEBUG
+
+#include "pomodoro_history.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char g_dir[] = "/tmp/pomodoro_history_test_XXXXXX";
+static char g_prefix[64];
+
+// 查询回调：统计记录并检查是否重复
+typedef struct {
+    long count;
+    int64_t times[4096];
+} VisitContext;
+
+static void CollectRecord(const SessionRecord* record, void* context) {
+    VisitContext* ctx = context;
+    assert(ctx->count < 4096);
+    ctx->times[ctx->count++] = record->startTime;
+}
+
+static long CountRangeSkipping(const HistoryArchive* archive, int64_t from, int64_t to,
+                               uint32_t* skipped) {
+    static VisitContext ctx;
+    ctx.count = 0;
+    long result = HistoryQueryRange(archive, from, to, CollectRecord, &ctx, skipped);
+    assert(result == ctx.count);
+    for (long i = 0; i < ctx.count; i++) {
+        for (long j = i + 1; j < ctx.count; j++) {
+            assert(ctx.times[i] != ctx.times[j]);
+        }
+    }
+    return result;
+}
+
+static long CountRange(const HistoryArchive* archive, int64_t from, int64_t to) {
+    uint32_t skipped;
+    long result = CountRangeSkipping(archive, from, to, &skipped);
+    assert(skipped == 0);
+    return result;
+}
+
+static SessionRecord MakeRecord(int64_t startTime, int isWorking) {
+    SessionRecord r;
+    r.startTime = startTime;
+    r.plannedSeconds = isWorking ? 1620 : 180;
+    r.elapsedSeconds = r.plannedSeconds + 1;
+    r.isWorking = (uint8_t)isWorking;
+    return r;
+}
+
+// 第 i 条测试记录的开始时间，间隔10分钟
+static int64_t TimeOf(int i) {
+    return 1700000000 + (int64_t)i * 600;
+}
+
+static void AppendRange(HistoryArchive* archive, int from, int to) {
+    for (int i = from; i < to; i++) {
+        SessionRecord r = MakeRecord(TimeOf(i), i % 2 == 0);
+        assert(HistoryAppend(archive, &r) == 0);
+    }
+}
+
+static void RemoveArchiveFiles(void) {
+    const char* names[] = {"dat", "idx", "log", "pending", "stage", "stage.tmp"};
+    char path[128];
+    for (int i = 0; i < 6; i++) {
+        snprintf(path, sizeof(path), "%spomodoro_history.%s", g_prefix, names[i]);
+        remove(path);
+    }
+}
+
+static void ResetArchive(HistoryArchive* archive) {
+    RemoveArchiveFiles();
+    assert(HistoryInit(archive, g_prefix) == 0);
+    assert(archive->nextSequence == 1);
+}
+
+static long FileSize(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static uint8_t* ReadFile(const char* path, long* size) {
+    *size = FileSize(path);
+    assert(*size >= 0);
+    uint8_t* data = malloc((size_t)*size + 1);
+    FILE* file = fopen(path, "rb");
+    assert(data && file);
+    assert(fread(data, 1, (size_t)*size, file) == (size_t)*size);
+    fclose(file);
+    return data;
+}
+
+static void WriteFile(const char* path, const uint8_t* data, long size) {
+    FILE* file = fopen(path, "wb");
+    assert(file);
+    assert(fwrite(data, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+}
+
+static void TestCodecRoundTrip(void) {
+    SessionRecord records[HISTORY_BLOCK_RECORDS];
+    int64_t t = 1700000000;
+    for (int i = 0; i < HISTORY_BLOCK_RECORDS; i++) {
+        records[i] = MakeRecord(t, i % 2 == 0);
+        if (i % 17 == 0) records[i].plannedSeconds = 600 + i;   // 计划时长变化
+        if (i % 5 == 0) records[i].elapsedSeconds = 30;          // 提前结束
+        t += records[i].elapsedSeconds + (i % 7 == 0 ? 3600 : 0);
+        if (i == 100) t -= 86400;                                // 时钟回拨
+    }
+
+    uint8_t encoded[HISTORY_BLOCK_RECORDS * HISTORY_MAX_RECORD_BYTES];
+    SessionRecord decoded[HISTORY_BLOCK_RECORDS];
+    size_t length = HistoryEncodeBlock(records, HISTORY_BLOCK_RECORDS, encoded);
+    assert(length > 0 && length < HISTORY_BLOCK_RECORDS * HISTORY_RAW_RECORD_BYTES);
+    assert(HistoryDecodeBlock(encoded, length, records[0].startTime,
+                              HISTORY_BLOCK_RECORDS, decoded) == 0);
+    for (int i = 0; i < HISTORY_BLOCK_RECORDS; i++) {
+        assert(decoded[i].startTime == records[i].startTime);
+        assert(decoded[i].plannedSeconds == records[i].plannedSeconds);
+        assert(decoded[i].elapsedSeconds == records[i].elapsedSeconds);
+        assert(decoded[i].isWorking == records[i].isWorking);
+    }
+
+    // 单条记录的块
+    length = HistoryEncodeBlock(records, 1, encoded);
+    assert(HistoryDecodeBlock(encoded, length, records[0].startTime, 1, decoded) == 0);
+    assert(decoded[0].startTime == records[0].startTime);
+}
+
+static void TestCorruptBlock(void) {
+    SessionRecord records[8];
+    for (int i = 0; i < 8; i++) records[i] = MakeRecord(TimeOf(i), i % 2 == 0);
+
+    uint8_t encoded[8 * HISTORY_MAX_RECORD_BYTES + 1];
+    SessionRecord decoded[8];
+    size_t length = HistoryEncodeBlock(records, 8, encoded);
+
+    // 截断、多余字节、记录数不符
+    assert(HistoryDecodeBlock(encoded, length - 1, TimeOf(0), 8, decoded) == -1);
+    encoded[length] = 0;
+    assert(HistoryDecodeBlock(encoded, length + 1, TimeOf(0), 8, decoded) == -1);
+    assert(HistoryDecodeBlock(encoded, length, TimeOf(0), 9, decoded) == -1);
+
+    // 非法标志字节（第一条记录的间隔为0，占1字节，其后是标志）
+    uint8_t saved = encoded[1];
+    encoded[1] = 0x7F;
+    assert(HistoryDecodeBlock(encoded, length, TimeOf(0), 8, decoded) == -1);
+    encoded[1] = saved;
+    assert(HistoryDecodeBlock(encoded, length, TimeOf(0), 8, decoded) == 0);
+
+    // 封存块损坏时跳过该块并报告，其余记录照常返回，而不是返回错误数据
+    HistoryArchive archive;
+    ResetArchive(&archive);
+    AppendRange(&archive, 0, 2 * HISTORY_BLOCK_RECORDS + 10);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 2 * HISTORY_BLOCK_RECORDS + 10);
+
+    long size;
+    uint8_t* data = ReadFile(archive.dataPath, &size);
+    data[size / 4] ^= 0x01;
+    WriteFile(archive.dataPath, data, size);
+    free(data);
+    uint32_t skipped;
+    assert(CountRangeSkipping(&archive, INT64_MIN, INT64_MAX, &skipped) ==
+           HISTORY_BLOCK_RECORDS + 10);
+    assert(skipped == 1);
+    assert(CountRange(&archive, TimeOf(HISTORY_BLOCK_RECORDS), INT64_MAX) ==
+           HISTORY_BLOCK_RECORDS + 10);
+
+    // 损坏的块不影响之后的封存
+    AppendRange(&archive, 2 * HISTORY_BLOCK_RECORDS + 10, 3 * HISTORY_BLOCK_RECORDS);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRangeSkipping(&archive, INT64_MIN, INT64_MAX, &skipped) ==
+           2 * HISTORY_BLOCK_RECORDS);
+    assert(skipped == 1);
+    HistoryClose(&archive);
+}
+
+static void TestRangeAcrossBlocks(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    // 两个封存块 + 暂存区 + 未压缩的日志
+    int sealedAndStaged = 2 * HISTORY_BLOCK_RECORDS + 40;
+    int total = sealedAndStaged + 10;
+    AppendRange(&archive, 0, sealedAndStaged);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.indexPath) == 2 * HISTORY_INDEX_ENTRY_BYTES);
+    assert(FileSize(archive.stagePath) == 40 * HISTORY_RAW_RECORD_BYTES);
+    AppendRange(&archive, sealedAndStaged, total);
+
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == total);
+
+    // 从第一个块中间到第二个块中间
+    int first = HISTORY_BLOCK_RECORDS / 2;
+    int last = HISTORY_BLOCK_RECORDS + 37;
+    assert(CountRange(&archive, TimeOf(first), TimeOf(last)) == last - first + 1);
+
+    // 范围端点落在两条记录之间
+    assert(CountRange(&archive, TimeOf(first) + 1, TimeOf(last) - 1) == last - first - 1);
+
+    // 只覆盖暂存区和日志
+    assert(CountRange(&archive, TimeOf(sealedAndStaged - 5), TimeOf(total)) == 15);
+
+    // 范围外、空范围
+    assert(CountRange(&archive, TimeOf(total), INT64_MAX) == 0);
+    assert(CountRange(&archive, INT64_MIN, TimeOf(0) - 1) == 0);
+    assert(CountRange(&archive, TimeOf(10), TimeOf(5)) == 0);
+    HistoryClose(&archive);
+}
+
+static void TestUnsealedSources(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    // 1个封存块 + 44条暂存
+    AppendRange(&archive, 0, 300);
+    assert(HistoryCompact(&archive) == 0);
+
+    // 压缩器已取走日志但尚未合并（pending），之后又有新日志
+    AppendRange(&archive, 300, 310);
+    assert(rename(archive.logPath, archive.pendingPath) == 0);
+    AppendRange(&archive, 310, 315);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 315);
+    assert(CountRange(&archive, TimeOf(298), TimeOf(312)) == 15);
+
+    // 第一次压缩处理遗留的 pending，第二次处理日志
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.pendingPath) == -1);
+    assert(FileSize(archive.logPath) == 5 * HISTORY_RAW_RECORD_BYTES);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.logPath) == -1);
+    assert(FileSize(archive.stagePath) == 59 * HISTORY_RAW_RECORD_BYTES);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 315);
+
+    // 重新初始化后序号继续递增，新记录不会被当作重复
+    HistoryArchive reopened;
+    assert(HistoryInit(&reopened, g_prefix) == 0);
+    assert(reopened.nextSequence == 316);
+    AppendRange(&reopened, 315, 320);
+    assert(HistoryCompact(&reopened) == 0);
+    assert(CountRange(&reopened, INT64_MIN, INT64_MAX) == 320);
+    HistoryClose(&reopened);
+    HistoryClose(&archive);
+}
+
+static void TestCrashBetweenSealAndStage(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    AppendRange(&archive, 0, 250);
+    assert(HistoryCompact(&archive) == 0);
+    AppendRange(&archive, 250, 260);
+    assert(rename(archive.logPath, archive.pendingPath) == 0);
+
+    long stageSize, pendingSize;
+    uint8_t* stage = ReadFile(archive.stagePath, &stageSize);
+    uint8_t* pending = ReadFile(archive.pendingPath, &pendingSize);
+
+    // 封存一个块后，恢复旧的暂存区和 pending，相当于在 WriteStage 之前崩溃
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.indexPath) == HISTORY_INDEX_ENTRY_BYTES);
+    WriteFile(archive.stagePath, stage, stageSize);
+    WriteFile(archive.pendingPath, pending, pendingSize);
+    free(stage);
+    free(pending);
+
+    // 查询和再次压缩都不会产生重复记录
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 260);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.indexPath) == HISTORY_INDEX_ENTRY_BYTES);
+    assert(FileSize(archive.stagePath) == 4 * HISTORY_RAW_RECORD_BYTES);
+    assert(FileSize(archive.pendingPath) == -1);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 260);
+
+    // 在删除旧暂存区后、改名临时文件前崩溃
+    assert(rename(archive.stagePath, archive.stageTmpPath) == 0);
+    AppendRange(&archive, 260, 262);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.stageTmpPath) == -1);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 262);
+
+    // 索引写入中断留下的半个索引项被忽略，块数据从有效位置重写
+    FILE* index = fopen(archive.indexPath, "ab");
+    assert(index);
+    fputs("torn", index);
+    fclose(index);
+    AppendRange(&archive, 262, 2 * HISTORY_BLOCK_RECORDS);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.indexPath) == 2 * HISTORY_INDEX_ENTRY_BYTES);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 2 * HISTORY_BLOCK_RECORDS);
+    HistoryClose(&archive);
+}
+
+static void AppendBytes(const char* path, const void* data, size_t size) {
+    FILE* file = fopen(path, "ab");
+    assert(file);
+    assert(fwrite(data, 1, size, file) == size);
+    fclose(file);
+}
+
+static void TestTornAppend(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    // 追加中断留下半条记录，重启后日志被修复，新记录正常对齐
+    AppendRange(&archive, 0, 3);
+    AppendBytes(archive.logPath, "0123456789", 10);
+    HistoryClose(&archive);
+    assert(HistoryInit(&archive, g_prefix) == 0);
+    assert(archive.nextSequence == 4);
+    assert(FileSize(archive.logPath) == 3 * HISTORY_RAW_RECORD_BYTES);
+    AppendRange(&archive, 3, 8);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 8);
+
+    // 未重启时残缺字节夹在记录中间，读取时重新对齐
+    AppendRange(&archive, 8, 10);
+    AppendBytes(archive.logPath, "torn", 4);
+    AppendRange(&archive, 10, 13);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 13);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 13);
+
+    // 单条记录损坏只丢失这一条，且不会以错误内容出现
+    AppendRange(&archive, 13, 16);
+    long size;
+    uint8_t* data = ReadFile(archive.logPath, &size);
+    assert(size == 3 * HISTORY_RAW_RECORD_BYTES);
+    data[HISTORY_RAW_RECORD_BYTES + 9] ^= 0x40;
+    WriteFile(archive.logPath, data, size);
+    free(data);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 15);
+    assert(CountRange(&archive, TimeOf(14), TimeOf(14)) == 0);
+    HistoryClose(&archive);
+    assert(HistoryInit(&archive, g_prefix) == 0);
+    assert(FileSize(archive.logPath) == 2 * HISTORY_RAW_RECORD_BYTES);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 15);
+    HistoryClose(&archive);
+}
+
+static void TestClockStepsBackward(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    AppendRange(&archive, 0, 1000);
+    assert(HistoryCompact(&archive) == 0);
+
+    // 系统时钟回拨一天后完成的记录照常保存
+    SessionRecord early = MakeRecord(TimeOf(0) - 86400, 1);
+    assert(HistoryAppend(&archive, &early) == 0);
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 1001);
+    assert(CountRange(&archive, early.startTime, early.startTime) == 1);
+
+    // 封存后仍可按时间查到
+    for (int i = 0; i < HISTORY_BLOCK_RECORDS; i++) {
+        SessionRecord r = MakeRecord(early.startTime + 1 + i, i % 2 == 0);
+        r.elapsedSeconds = 1;
+        assert(HistoryAppend(&archive, &r) == 0);
+    }
+    assert(HistoryCompact(&archive) == 0);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == 1001 + HISTORY_BLOCK_RECORDS);
+    assert(CountRange(&archive, early.startTime, TimeOf(0) - 1) == 1 + HISTORY_BLOCK_RECORDS);
+    HistoryClose(&archive);
+}
+
+#define CONCURRENT_RECORDS 2000
+
+typedef struct {
+    HistoryArchive* archive;
+    pthread_mutex_t mutex;
+    int done;
+} CompactorState;
+
+static int IsDone(CompactorState* state) {
+    pthread_mutex_lock(&state->mutex);
+    int done = state->done;
+    pthread_mutex_unlock(&state->mutex);
+    return done;
+}
+
+static void* CompactorThread(void* arg) {
+    CompactorState* state = arg;
+    while (!IsDone(state)) {
+        assert(HistoryCompact(state->archive) == 0);
+    }
+    return NULL;
+}
+
+static void TestConcurrentAppend(void) {
+    HistoryArchive archive;
+    ResetArchive(&archive);
+
+    // 追加与压缩并发：日志改名不会吞掉正在写入的记录
+    CompactorState state = {&archive, PTHREAD_MUTEX_INITIALIZER, 0};
+    pthread_t thread;
+    assert(pthread_create(&thread, NULL, CompactorThread, &state) == 0);
+    AppendRange(&archive, 0, CONCURRENT_RECORDS);
+    pthread_mutex_lock(&state.mutex);
+    state.done = 1;
+    pthread_mutex_unlock(&state.mutex);
+    assert(pthread_join(thread, NULL) == 0);
+
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == CONCURRENT_RECORDS);
+    assert(HistoryCompact(&archive) == 0);
+    assert(HistoryCompact(&archive) == 0);
+    assert(FileSize(archive.logPath) == -1);
+    assert(FileSize(archive.pendingPath) == -1);
+    assert(CountRange(&archive, INT64_MIN, INT64_MAX) == CONCURRENT_RECORDS);
+    HistoryClose(&archive);
+}
+
+int main(void) {
+    assert(mkdtemp(g_dir));
+    snprintf(g_prefix, sizeof(g_prefix), "%s/", g_dir);
+
+    TestCodecRoundTrip();
+    TestCorruptBlock();
+    TestRangeAcrossBlocks();
+    TestUnsealedSources();
+    TestCrashBetweenSealAndStage();
+    TestClockStepsBackward();
+    TestConcurrentAppend();
+    TestTornAppend();
+
+    RemoveArchiveFiles();
+    rmdir(g_dir);
+    printf("history_test: all tests passed\n");
+    return 0;
+}